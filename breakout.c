@@ -1,11 +1,42 @@
+#if defined(__unix__) || defined(__APPLE__)
+// Sockets for spectator broadcast
+#define _POSIX_C_SOURCE 200809L
+#endif
+#if defined(__APPLE__)
+// `_POSIX_C_SOURCE` hides `SO_NOSIGPIPE` on Darwin
+#define _DARWIN_C_SOURCE
+#endif
+
 #include <errno.h>
+#include <float.h>
 #include <inttypes.h>
 #include <raylib.h>
 #include <raymath.h>
+#include <signal.h>
 #include <stdbool.h>
 #include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <time.h>
+#include <unistd.h>
+
+#define BROADCAST_SUPPORTED
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0
+#ifndef SO_NOSIGPIPE
+// Writing to a disconnected viewer must not kill the host
+#define BROADCAST_IGNORE_SIGPIPE
+#endif
+#endif
+#endif
 
 #if defined(__SSE__) || defined(__x86_64__) || defined(_M_X64) || defined(_M_IX86)
 #include <xmmintrin.h>
@@ -72,6 +103,23 @@ static inline void Normalize2(Vector2 *vec) {
 #define BRICK_VCOUNT 8
 #define BRICK_COLOR LIGHTGRAY
 #define BRICK_COLOR_ALT DARKGRAY
+#define BRICK_BITMAP_SIZE ((BRICK_HCOUNT * BRICK_VCOUNT + 7) / 8)
+#define BRICK_INDEX_BITS 7
+
+// Flipped brick count in deltas uses the same width, so it must fit all bricks too
+#if BRICK_HCOUNT * BRICK_VCOUNT >= (1 << BRICK_INDEX_BITS)
+#error "BRICK_INDEX_BITS is too small for the brick wall"
+#endif
+
+#define PREDICTION_MAX_BOUNCES 32
+#define PREDICTION_TOLERANCE 1.0f
+
+#define HEADLESS_DELTA_TIME (1.0f / 60.0f)
+
+#define MAX_VIEWERS 256
+#define BROADCAST_HISTORY 64
+#define BROADCAST_MESSAGE_SIZE 256
+#define BROADCAST_DELTA_CACHE 8
 
 typedef struct GameState {
     bool gameOver;
@@ -117,6 +165,92 @@ typedef struct PowerUp {
     float displayTimer;
 } PowerUp;
 
+typedef enum BodyKind {
+    BODY_BALL,
+    BODY_PLAYER,
+} BodyKind;
+
+// Moving object tracked by the broad-phase, bounds are refreshed on every update
+typedef struct Body {
+    BodyKind kind;
+    void *object;
+    float minX;
+    float maxX;
+    float minY;
+    float maxY;
+} Body;
+
+// Sort-and-sweep broad-phase for collisions between moving objects.
+// Bodies are kept sorted by `minX`, order barely changes between frames
+// so insertion sort keeps it sorted in close to linear time
+typedef struct BroadPhase {
+    Body *bodies;
+    int count;
+    int capacity;
+} BroadPhase;
+
+typedef void (*BodyPairF)(Body *a, Body *b, void *ctx);
+
+// State sent to spectators for a single tick
+typedef struct Snapshot {
+    uint32_t tick;
+    Rectangle player;
+    Vector2 ballPos;
+    Vector2 ballVelocity;
+    uint8_t bricks[BRICK_BITMAP_SIZE]; // alive-brick bitmap, bit `r * BRICK_HCOUNT + c`
+    int32_t points;
+    int32_t lives;
+    bool gameOver;
+} Snapshot;
+
+typedef struct Viewer {
+    int fd;
+    uint32_t firstTick; // first tick sent to this viewer
+    uint32_t ackedTick;
+    bool acked;
+    uint8_t ack[4]; // partially received acknowledgement
+    int ackSize;
+} Viewer;
+
+// Streams game state to local spectators over a Unix socket.
+// Viewers acknowledge ticks they received, then get deltas against
+// the last acknowledged tick, or a keyframe if it is no longer kept
+typedef struct Broadcast {
+    int fd;
+    const char *path;
+    Viewer viewers[MAX_VIEWERS];
+    int viewerCount;
+    Snapshot history[BROADCAST_HISTORY]; // indexed by `tick % BROADCAST_HISTORY`
+    uint32_t tick;
+} Broadcast;
+
+// Predicted path of the ball down to the player, kept until the ball leaves it.
+// Segment `i` starts at `origins[i]`, is travelled with `velocities[i]`
+// and ends bouncing off `hits[i]` (NULL for arena walls)
+typedef struct Prediction {
+    Vector2 origins[PREDICTION_MAX_BOUNCES];
+    Vector2 velocities[PREDICTION_MAX_BOUNCES];
+    const Brick *hits[PREDICTION_MAX_BOUNCES];
+    int segmentCount;
+    int segment;
+    Vector2 landing;
+    bool found;
+    bool valid;
+} Prediction;
+
+typedef struct BitWriter {
+    uint8_t *data;
+    size_t capacity;
+    size_t bits;
+} BitWriter;
+
+// Delta encoded for one tick against `baseTick`, shared by viewers that acknowledged it
+typedef struct EncodedDelta {
+    uint32_t baseTick;
+    size_t size;
+    uint8_t data[BROADCAST_MESSAGE_SIZE];
+} EncodedDelta;
+
 void PowerUpIncPlayerSize(Player *player, Ball *ball);
 void PowerUpIncPlayerSize2(Player *player, Ball *ball);
 
@@ -141,6 +275,7 @@ Vector2 PlayerBottomMid(const Player *player);
 Rectangle PlayerRect(const Player *player);
 
 int InitBall(Ball *ball, const Player *player);
+void LaunchBall(Ball *ball);
 void DrawBall(const Ball *ball);
 void UpdateBall(Ball *ball, Player *player, BrickWall *wall, GameState *state, float deltaTime);
 void BallHandlePlayerCollision(Ball *ball, const Player *player);
@@ -152,14 +287,111 @@ int InitBrickWall(BrickWall *wall);
 void DrawBrickWall(const BrickWall *wall);
 Brick *BallCheckWallCollision(const BrickWall *wall, const Ball *ball);
 
-int main(void) {
+int InitBroadPhase(BroadPhase *bp, int capacity);
+int BroadPhaseAdd(BroadPhase *bp, BodyKind kind, void *object);
+int BroadPhaseRemove(BroadPhase *bp, const void *object);
+void CloseBroadPhase(BroadPhase *bp);
+void UpdateBroadPhase(BroadPhase *bp);
+void BroadPhaseForEachPair(const BroadPhase *bp, BodyPairF handle, void *ctx);
+Rectangle BodyBounds(const Body *body);
+bool CheckCollisionBodies(const Body *a, const Body *b);
+void HandleBodyCollision(Body *a, Body *b, void *ctx);
+void BallHandleBallCollision(Ball *ball, Ball *other);
+
+void UpdatePrediction(
+    Prediction *pred,
+    const Ball *ball,
+    const Player *player,
+    const BrickWall *wall,
+    float deltaTime
+);
+void PredictBallLanding(Prediction *pred, const Ball *ball, const Player *player, const BrickWall *wall);
+bool RayCastBrickWall(
+    const BrickWall *wall,
+    Vector2 origin,
+    Vector2 dir,
+    float radius,
+    float maxT,
+    const Prediction *pred,
+    float *t,
+    bool *vertical,
+    const Brick **hit
+);
+bool RayCastRect(Vector2 origin, Vector2 dir, Rectangle rect, float *t, bool *vertical);
+bool RayCastBrick(Vector2 origin, Vector2 dir, Rectangle rect, float radius, float *t, bool *vertical);
+void DrawPrediction(const Prediction *pred, const Ball *ball);
+
+int InitBroadcast(Broadcast *bc, const char *path);
+void UpdateBroadcast(
+    Broadcast *bc,
+    const Player *player,
+    const Ball *ball,
+    const BrickWall *wall,
+    const GameState *state
+);
+void CloseBroadcast(Broadcast *bc);
+void BroadcastAcceptViewers(Broadcast *bc);
+bool BroadcastReadAcks(Broadcast *bc, Viewer *viewer);
+void BroadcastRemoveViewer(Broadcast *bc, int index);
+void CaptureSnapshot(
+    Snapshot *snap,
+    uint32_t tick,
+    const Player *player,
+    const Ball *ball,
+    const BrickWall *wall,
+    const GameState *state
+);
+size_t EncodeSnapshot(uint8_t *buffer, size_t size, const Snapshot *snap, const Snapshot *base);
+void WriteBits(BitWriter *writer, uint32_t value, int count);
+void WriteFloatBits(BitWriter *writer, float value);
+
+void InstallStopHandlers(void);
+void HandleStopSignal(int sig);
+void WaitHeadlessFrame(void);
+
+// Set from signal handlers to end the headless loop cleanly
+static volatile sig_atomic_t stopRequested = 0;
+
+// Tests and benchmarks include this file and bring their own `main`
+#ifndef BREAKOUT_NO_MAIN
+int main(int argc, char **argv) {
     const int width = 800;
     const int height = 450;
 
+    // --broadcast <path>: stream the game to spectators on a Unix socket
+    // --headless: no window, ball is served automatically, runs until interrupted
+    const char *broadcastPath = NULL;
+    bool headless = false;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--broadcast") == 0 && i + 1 < argc) {
+            broadcastPath = argv[++i];
+        } else if (strcmp(argv[i], "--headless") == 0) {
+            headless = true;
+        }
+    }
+
+    // Nothing would observe a headless game without spectators
+    if (headless && broadcastPath == NULL) {
+        fprintf(stderr, "--headless requires --broadcast <path>\n");
+        return 1;
+    }
+
     SetTraceLogLevel(LOG_DEBUG);
-    InitWindow(width, height, "Breakout");
 
-    SetTargetFPS(60);
+    Broadcast broadcast;
+    int err = InitBroadcast(&broadcast, broadcastPath);
+    if (err != 0) {
+        fprintf(stderr, "Failed to broadcast on %s: %s\n", broadcastPath, strerror(err));
+        return 1;
+    }
+
+    if (headless) {
+        InstallStopHandlers();
+    } else {
+        InitWindow(width, height, "Breakout");
+
+        SetTargetFPS(60);
+    }
 
     GameState state;
     InitGameState(&state);
@@ -173,6 +405,15 @@ int main(void) {
     BrickWall wall;
     InitBrickWall(&wall);
 
+    BroadPhase broadPhase;
+    InitBroadPhase(&broadPhase, 2);
+    BroadPhaseAdd(&broadPhase, BODY_PLAYER, &player);
+    BroadPhaseAdd(&broadPhase, BODY_BALL, &ball);
+
+    // Assist mode shows where the ball will reach the player, toggled with A
+    bool assist = false;
+    Prediction prediction = {0};
+
     size_t maxPoints = BRICK_HCOUNT * BRICK_VCOUNT;
     PowerUp powerUps[MAX_POWERUPS] = {
         (PowerUp){&PowerUpIncPlayerSpeed, "+ Speed", 0, false, 2.0f},
@@ -187,14 +428,26 @@ int main(void) {
         powerUps[i].threshold = (i + 1) * maxPoints / (MAX_POWERUPS + 1);
     }
 
-    while (!WindowShouldClose()) {
+    while (!stopRequested && (headless || !WindowShouldClose())) {
         // Update
         if (state.gameOver) goto render;
 
-        float deltaTime = GetFrameTime();
+        // Headless host has no frame timing, run at a fixed step
+        float deltaTime = headless ? HEADLESS_DELTA_TIME : GetFrameTime();
+
+        // Nobody can press SPACE on a headless host
+        if (headless && !ball.enabled) LaunchBall(&ball);
 
         UpdatePlayer(&player, deltaTime);
+
+        // Collisions between moving objects (ball-player, ball-ball)
+        UpdateBroadPhase(&broadPhase);
+        BroadPhaseForEachPair(&broadPhase, &HandleBodyCollision, NULL);
+
         UpdateBall(&ball, &player, &wall, &state, deltaTime);
+        UpdatePrediction(&prediction, &ball, &player, &wall, deltaTime);
+
+        if (IsKeyPressed(KEY_A)) assist = !assist;
 
         // Reward player
         for (size_t i = 0; i < MAX_POWERUPS; i++) {
@@ -225,6 +478,14 @@ int main(void) {
 
         // Render
     render:
+        // Spectators keep receiving state after game over
+        UpdateBroadcast(&broadcast, &player, &ball, &wall, &state);
+
+        if (headless) {
+            WaitHeadlessFrame();
+            continue;
+        }
+
         BeginDrawing();
 
         ClearBackground(RAYWHITE);
@@ -234,6 +495,7 @@ int main(void) {
         DrawPlayer(&player);
         DrawBall(&ball);
         DrawBrickWall(&wall);
+        if (assist) DrawPrediction(&prediction, &ball);
 
         // Draw lives
         for (int i = 0; i < player.lives; i++) {
@@ -261,10 +523,13 @@ int main(void) {
         EndDrawing();
     }
 
-    CloseWindow();
+    CloseBroadPhase(&broadPhase);
+    CloseBroadcast(&broadcast);
+    if (!headless) CloseWindow();
 
     return 0;
 }
+#endif
 
 void PowerUpIncPlayerSize(Player *player, Ball *ball) {
     if (player == NULL) return;
@@ -375,7 +640,7 @@ void UpdatePlayer(Player *player, float deltaTime) {
         player->rect.x -= movement;
     }
 
-    int screenWidth = GetScreenWidth();
+    int screenWidth = SCREEN_WIDTH;
     if (player->rect.x < 0.0f) {
         player->rect.x = 0.0f;
     } else if (player->rect.x + player->rect.width >= screenWidth) {
@@ -419,6 +684,15 @@ int InitBall(Ball *ball, const Player *player) {
     return 0;
 }
 
+void LaunchBall(Ball *ball) {
+    if (ball == NULL) return;
+
+    ball->enabled = true;
+    ball->speed = BALL_SPEED;
+    ball->velocity.x = 0.0f;
+    ball->velocity.y = -1.0f;
+}
+
 void DrawBall(const Ball *ball) {
     if (ball == NULL) return;
 
@@ -432,18 +706,12 @@ void UpdateBall(Ball *ball, Player *player, BrickWall *wall, GameState *state, f
     // If ball is not enabled, either start by pressing SPACE
     // or attach the ball to the player
     if (!ball->enabled && IsKeyPressed(KEY_SPACE)) {
-        ball->enabled = true;
-        ball->speed = BALL_SPEED;
-        ball->velocity.x = 0.0f;
-        ball->velocity.y = -1.0f;
+        LaunchBall(ball);
     } else if (!ball->enabled) {
         ball->pos.x = PlayerBottomMid(player).x;
         return;
     }
 
-    // Check and handle collision with player
-    BallHandlePlayerCollision(ball, player);
-
     // Check if we hit a brick
     Brick *collided = BallCheckWallCollision(wall, ball);
     if (collided != NULL) {
@@ -625,8 +893,9 @@ void BallHandleArenaCollision(Ball *ball, Player *player, GameState *state) {
     if (ball == NULL) return;
     if (player == NULL) return;
 
-    int width = GetScreenWidth();
-    int height = GetScreenHeight();
+    // Arena size is fixed, this also works without a window (headless host)
+    int width = SCREEN_WIDTH;
+    int height = SCREEN_HEIGHT;
 
     if (ball->prevPos.x < ball->radius) {
         // Left/Right wall collision
@@ -711,3 +980,954 @@ Brick *BallCheckWallCollision(const BrickWall *wall, const Ball *ball) {
 
     return NULL;
 }
+
+int InitBroadPhase(BroadPhase *bp, int capacity) {
+    if (bp == NULL) return EINVAL;
+    if (capacity < 1) return EINVAL;
+
+    *bp = (BroadPhase){NULL, 0, capacity};
+
+    bp->bodies = (Body *)calloc(capacity, sizeof(Body));
+    if (bp->bodies == NULL) return ENOMEM;
+
+    return 0;
+}
+
+int BroadPhaseAdd(BroadPhase *bp, BodyKind kind, void *object) {
+    if (bp == NULL) return EINVAL;
+    if (object == NULL) return EINVAL;
+
+    if (bp->count == bp->capacity) {
+        Body *bodies = (Body *)realloc(bp->bodies, 2 * bp->capacity * sizeof(Body));
+        if (bodies == NULL) return ENOMEM;
+
+        bp->bodies = bodies;
+        bp->capacity *= 2;
+    }
+
+    // Bounds are filled in by the next update, which also sorts the new body in
+    bp->bodies[bp->count++] = (Body){kind, object, 0.0f, 0.0f, 0.0f, 0.0f};
+
+    return 0;
+}
+
+int BroadPhaseRemove(BroadPhase *bp, const void *object) {
+    if (bp == NULL) return EINVAL;
+    if (object == NULL) return EINVAL;
+
+    for (int i = 0; i < bp->count; i++) {
+        if (bp->bodies[i].object != object) continue;
+
+        // Move the last body into the gap, the next update sorts it back in place
+        bp->bodies[i] = bp->bodies[--bp->count];
+        return 0;
+    }
+
+    return ENOENT;
+}
+
+void CloseBroadPhase(BroadPhase *bp) {
+    if (bp == NULL) return;
+
+    free(bp->bodies);
+    *bp = (BroadPhase){NULL, 0, 0};
+}
+
+void UpdateBroadPhase(BroadPhase *bp) {
+    if (bp == NULL) return;
+
+    for (int i = 0; i < bp->count; i++) {
+        Body *body = &(bp->bodies[i]);
+        Rectangle bounds = BodyBounds(body);
+
+        body->minX = bounds.x;
+        body->maxX = bounds.x + bounds.width;
+        body->minY = bounds.y;
+        body->maxY = bounds.y + bounds.height;
+    }
+
+    // Insertion sort by `minX`, bodies only move a few places (if any) per frame
+    for (int i = 1; i < bp->count; i++) {
+        Body body = bp->bodies[i];
+
+        int j = i - 1;
+        while (j >= 0 && bp->bodies[j].minX > body.minX) {
+            bp->bodies[j + 1] = bp->bodies[j];
+            j--;
+        }
+        bp->bodies[j + 1] = body;
+    }
+}
+
+void BroadPhaseForEachPair(const BroadPhase *bp, BodyPairF handle, void *ctx) {
+    if (bp == NULL) return;
+    if (handle == NULL) return;
+
+    for (int i = 0; i < bp->count; i++) {
+        Body *a = &(bp->bodies[i]);
+
+        // Bodies are sorted by `minX`, so the first body starting after `a`
+        // ends means none of the remaining ones can overlap with `a` either
+        for (int j = i + 1; j < bp->count && bp->bodies[j].minX <= a->maxX; j++) {
+            Body *b = &(bp->bodies[j]);
+            if (b->minY > a->maxY || b->maxY < a->minY) continue;
+            if (!CheckCollisionBodies(a, b)) continue;
+
+            handle(a, b, ctx);
+        }
+    }
+}
+
+Rectangle BodyBounds(const Body *body) {
+    if (body == NULL) return (Rectangle){0};
+
+    switch (body->kind) {
+    case BODY_BALL: {
+        // Collisions are resolved against the previous position, see `BallHandlePlayerCollision`
+        const Ball *ball = (const Ball *)body->object;
+        return (Rectangle){
+            ball->prevPos.x - ball->radius,
+            ball->prevPos.y - ball->radius,
+            2.0f * ball->radius,
+            2.0f * ball->radius,
+        };
+    }
+    case BODY_PLAYER:
+        return PlayerRect((const Player *)body->object);
+    }
+
+    return (Rectangle){0};
+}
+
+bool CheckCollisionBodies(const Body *a, const Body *b) {
+    if (a == NULL) return false;
+    if (b == NULL) return false;
+
+    // Order pair by kind to halve the cases below
+    if (a->kind > b->kind) {
+        const Body *tmp = a;
+        a = b;
+        b = tmp;
+    }
+
+    if (a->kind == BODY_BALL) {
+        const Ball *ball = (const Ball *)a->object;
+        if (!ball->enabled) return false;
+
+        if (b->kind == BODY_BALL) {
+            const Ball *other = (const Ball *)b->object;
+            if (!other->enabled) return false;
+
+            return CheckCollisionCircles(ball->prevPos, ball->radius, other->prevPos, other->radius);
+        }
+
+        return CheckCollisionCircleRec(ball->prevPos, ball->radius, BodyBounds(b));
+    }
+
+    return CheckCollisionRecs(BodyBounds(a), BodyBounds(b));
+}
+
+void HandleBodyCollision(Body *a, Body *b, void *ctx) {
+    if (a == NULL) return;
+    if (b == NULL) return;
+    (void)ctx;
+
+    if (a->kind > b->kind) {
+        Body *tmp = a;
+        a = b;
+        b = tmp;
+    }
+
+    if (a->kind != BODY_BALL) return;
+
+    switch (b->kind) {
+    case BODY_BALL:
+        BallHandleBallCollision((Ball *)a->object, (Ball *)b->object);
+        break;
+    case BODY_PLAYER:
+        BallHandlePlayerCollision((Ball *)a->object, (const Player *)b->object);
+        break;
+    }
+}
+
+void BallHandleBallCollision(Ball *ball, Ball *other) {
+    if (ball == NULL) return;
+    if (other == NULL) return;
+
+    // Contact normal, pointing from `other` towards `ball`
+    Vector2 normal = {
+        ball->prevPos.x - other->prevPos.x,
+        ball->prevPos.y - other->prevPos.y,
+    };
+    float distanceSq = normal.x * normal.x + normal.y * normal.y;
+
+    // Same center, there is no meaningful normal to bounce off of
+    if (distanceSq < CIRCLE_RECT_COLLISION_EPSILON) return;
+
+    float rsqrt = RSqrt(distanceSq);
+    normal.x *= rsqrt;
+    normal.y *= rsqrt;
+
+    // Reflect only the balls moving into each other. `normal` is only
+    // approximately unit length, normalize again so velocity doesn't shrink
+    // a little on every contact
+    float dot = ball->velocity.x * normal.x + ball->velocity.y * normal.y;
+    if (dot < 0.0f) {
+        ball->velocity.x -= 2.0f * dot * normal.x;
+        ball->velocity.y -= 2.0f * dot * normal.y;
+        Normalize2(&(ball->velocity));
+    }
+
+    dot = other->velocity.x * normal.x + other->velocity.y * normal.y;
+    if (dot > 0.0f) {
+        other->velocity.x -= 2.0f * dot * normal.x;
+        other->velocity.y -= 2.0f * dot * normal.y;
+        Normalize2(&(other->velocity));
+    }
+
+    // Separate the balls evenly so they don't collide again on the next frame
+    float overlap = (ball->radius + other->radius) - distanceSq * rsqrt;
+    if (overlap > 0.0f) {
+        ball->pos.x += normal.x * overlap / 2.0f;
+        ball->pos.y += normal.y * overlap / 2.0f;
+        other->pos.x -= normal.x * overlap / 2.0f;
+        other->pos.y -= normal.y * overlap / 2.0f;
+    }
+}
+
+void UpdatePrediction(
+    Prediction *pred,
+    const Ball *ball,
+    const Player *player,
+    const BrickWall *wall,
+    float deltaTime
+) {
+    if (pred == NULL) return;
+    if (ball == NULL) return;
+
+    if (!ball->enabled) {
+        pred->valid = false;
+        pred->found = false;
+        return;
+    }
+
+    // Still valid if the ball is on the cached segment or bounced into the next one
+    Vector2 vel = ball->velocity;
+    if (pred->valid) {
+        Vector2 current = pred->velocities[pred->segment];
+        if (vel.x != current.x || vel.y != current.y) {
+            int next = pred->segment + 1;
+            if (next < pred->segmentCount && vel.x == pred->velocities[next].x && vel.y == pred->velocities[next].y) {
+                pred->segment = next;
+            } else {
+                pred->valid = false;
+            }
+        }
+    }
+
+    // Collision handling snaps the ball out of walls and bricks, which can
+    // move it off the predicted line without changing its velocity
+    if (pred->valid) {
+        Vector2 origin = pred->origins[pred->segment];
+        Vector2 current = pred->velocities[pred->segment];
+        float offset = (ball->pos.x - origin.x) * current.y - (ball->pos.y - origin.y) * current.x;
+        if (offset > PREDICTION_TOLERANCE || offset < -PREDICTION_TOLERANCE) pred->valid = false;
+    }
+
+    // Ball went past the end of the segment without bouncing. It may be up to
+    // one frame of movement past it before collision handling reflects it.
+    // Without a landing, the last segment was cut off by the bounce limit
+    // (or the ball isn't moving) and has no end to go past
+    bool hasEnd = pred->segment + 1 < pred->segmentCount || pred->found;
+    if (pred->valid && hasEnd) {
+        Vector2 origin = pred->origins[pred->segment];
+        Vector2 current = pred->velocities[pred->segment];
+        Vector2 end = pred->segment + 1 < pred->segmentCount ? pred->origins[pred->segment + 1] : pred->landing;
+        float length = (end.x - origin.x) * current.x + (end.y - origin.y) * current.y;
+        float progress = (ball->pos.x - origin.x) * current.x + (ball->pos.y - origin.y) * current.y;
+        if (progress > length + ball->speed * deltaTime + PREDICTION_TOLERANCE) pred->valid = false;
+    }
+
+    // Path goes through bricks that were destroyed some other way
+    for (int i = pred->segment; pred->valid && i < pred->segmentCount; i++) {
+        if (pred->hits[i] != NULL && !pred->hits[i]->enabled) pred->valid = false;
+    }
+
+    if (!pred->valid) PredictBallLanding(pred, ball, player, wall);
+}
+
+void PredictBallLanding(Prediction *pred, const Ball *ball, const Player *player, const BrickWall *wall) {
+    if (pred == NULL) return;
+    if (ball == NULL) return;
+    if (player == NULL) return;
+
+    *pred = (Prediction){0};
+    pred->valid = true;
+
+    float width = SCREEN_WIDTH;
+    float radius = ball->radius;
+    float landingY = player->rect.y - radius;
+
+    Vector2 pos = ball->pos;
+    Vector2 vel = ball->velocity;
+
+    for (int i = 0; i < PREDICTION_MAX_BOUNCES; i++) {
+        pred->origins[i] = pos;
+        pred->velocities[i] = vel;
+        pred->segmentCount = i + 1;
+
+        // Distance along velocity to the side walls and to the top wall or the player.
+        // Clamp to zero if the ball is already past one, arena collision reflects it next
+        float tx = FLT_MAX;
+        if (vel.x < -EPSILON) tx = (radius - pos.x) / vel.x;
+        if (vel.x > EPSILON) tx = (width - radius - pos.x) / vel.x;
+        if (tx < 0.0f) tx = 0.0f;
+
+        float ty = FLT_MAX;
+        if (vel.y < -EPSILON) ty = (radius - pos.y) / vel.y;
+        if (vel.y > EPSILON) ty = (landingY - pos.y) / vel.y;
+        if (ty < 0.0f) ty = 0.0f;
+
+        float t = tx < ty ? tx : ty;
+        bool vertical = tx < ty;
+
+        const Brick *brick = NULL;
+        float brickT = 0.0f;
+        bool brickVertical = false;
+        if (RayCastBrickWall(wall, pos, vel, radius, t, pred, &brickT, &brickVertical, &brick)) {
+            t = brickT;
+            vertical = brickVertical;
+        }
+
+        if (t == FLT_MAX) return; // Not moving
+        pos.x += vel.x * t;
+        pos.y += vel.y * t;
+
+        if (brick == NULL && !vertical && vel.y > 0.0f) {
+            pred->landing = pos;
+            pred->found = true;
+            return;
+        }
+
+        pred->hits[i] = brick;
+        if (vertical) {
+            vel.x = -vel.x;
+        } else {
+            vel.y = -vel.y;
+        }
+    }
+}
+
+bool RayCastBrickWall(
+    const BrickWall *wall,
+    Vector2 origin,
+    Vector2 dir,
+    float radius,
+    float maxT,
+    const Prediction *pred,
+    float *t,
+    bool *vertical,
+    const Brick **hit
+) {
+    if (wall == NULL) return false;
+    if (t == NULL || vertical == NULL || hit == NULL) return false;
+
+    // DDA over brick cells (a brick and the gaps after it) with one ring of empty
+    // cells around the wall. Ball is within `radius` of a brick only from that
+    // brick's cell or its neighbours, so checking those on each visited cell
+    // finds the first brick on the path
+    const float cellW = BRICK_WIDTH + BRICK_HGAP;
+    const float cellH = BRICK_HEIGHT + BRICK_VGAP;
+    const int cols = BRICK_HCOUNT + 2;
+    const int rows = BRICK_VCOUNT + 2;
+    Rectangle grid = {BRICK_HPAD - cellW, BRICK_VPAD - cellH, cols * cellW, rows * cellH};
+
+    float enterT = 0.0f;
+    bool enterVertical = false;
+    if (!CheckCollisionPointRec(origin, grid) && !RayCastRect(origin, dir, grid, &enterT, &enterVertical)) return false;
+    if (enterT > maxT) return false;
+
+    Vector2 enter = {origin.x + dir.x * enterT, origin.y + dir.y * enterT};
+    int cx = Clamp((enter.x - grid.x) / cellW, 0, cols - 1);
+    int cy = Clamp((enter.y - grid.y) / cellH, 0, rows - 1);
+
+    int stepX = dir.x > 0.0f ? 1 : -1;
+    int stepY = dir.y > 0.0f ? 1 : -1;
+    float deltaX = dir.x != 0.0f ? cellW / fabsf(dir.x) : FLT_MAX;
+    float deltaY = dir.y != 0.0f ? cellH / fabsf(dir.y) : FLT_MAX;
+    float nextX = dir.x != 0.0f ? (grid.x + (cx + (stepX > 0)) * cellW - origin.x) / dir.x : FLT_MAX;
+    float nextY = dir.y != 0.0f ? (grid.y + (cy + (stepY > 0)) * cellH - origin.y) / dir.y : FLT_MAX;
+
+    float bestT = FLT_MAX;
+    bool bestVertical = false;
+    const Brick *best = NULL;
+
+    while (cx >= 0 && cx < cols && cy >= 0 && cy < rows) {
+        // Cell (cx, cy) holds brick (cy - 1, cx - 1), test it and its neighbours
+        for (int r = cy - 2; r <= cy; r++) {
+            if (r < 0 || r >= BRICK_VCOUNT) continue;
+
+            for (int c = cx - 2; c <= cx; c++) {
+                if (c < 0 || c >= BRICK_HCOUNT) continue;
+
+                const Brick *brick = &(wall->bricks[r][c]);
+                if (!brick->enabled) continue;
+
+                // Bricks hit earlier on the predicted path will be destroyed by then
+                bool destroyed = false;
+                for (int i = 0; pred != NULL && i < pred->segmentCount; i++) {
+                    if (pred->hits[i] == brick) destroyed = true;
+                }
+                if (destroyed) continue;
+
+                float brickT = 0.0f;
+                bool brickVertical = false;
+                if (!RayCastBrick(origin, dir, brick->rect, radius, &brickT, &brickVertical)) continue;
+                if (brickT >= bestT) continue;
+
+                bestT = brickT;
+                bestVertical = brickVertical;
+                best = brick;
+            }
+        }
+
+        float exitT = nextX < nextY ? nextX : nextY;
+        if (bestT <= exitT || exitT > maxT) break;
+
+        if (nextX < nextY) {
+            cx += stepX;
+            nextX += deltaX;
+        } else {
+            cy += stepY;
+            nextY += deltaY;
+        }
+    }
+
+    if (best == NULL || bestT > maxT) return false;
+
+    *t = bestT;
+    *vertical = bestVertical;
+    *hit = best;
+
+    return true;
+}
+
+// Slab test, only hits in front of the origin count. `vertical` is set when
+// the ray enters through the left or right side
+bool RayCastRect(Vector2 origin, Vector2 dir, Rectangle rect, float *t, bool *vertical) {
+    if (t == NULL || vertical == NULL) return false;
+
+    float nearT = -FLT_MAX;
+    float farT = FLT_MAX;
+    bool nearVertical = false;
+
+    if (dir.x != 0.0f) {
+        float t0 = (rect.x - origin.x) / dir.x;
+        float t1 = (rect.x + rect.width - origin.x) / dir.x;
+        if (t0 > t1) {
+            float tmp = t0;
+            t0 = t1;
+            t1 = tmp;
+        }
+
+        nearT = t0;
+        nearVertical = true;
+        farT = t1;
+    } else if (origin.x < rect.x || origin.x > rect.x + rect.width) {
+        return false;
+    }
+
+    if (dir.y != 0.0f) {
+        float t0 = (rect.y - origin.y) / dir.y;
+        float t1 = (rect.y + rect.height - origin.y) / dir.y;
+        if (t0 > t1) {
+            float tmp = t0;
+            t0 = t1;
+            t1 = tmp;
+        }
+
+        if (t0 > nearT) {
+            nearT = t0;
+            nearVertical = false;
+        }
+        if (t1 < farT) farT = t1;
+    } else if (origin.y < rect.y || origin.y > rect.y + rect.height) {
+        return false;
+    }
+
+    if (nearT > farT || nearT < 0.0f) return false;
+
+    *t = nearT;
+    *vertical = nearVertical;
+
+    return true;
+}
+
+// Ray cast of the ball center against the brick grown by the ball radius,
+// with rounded corners like `CheckCollisionCircleRec`
+bool RayCastBrick(Vector2 origin, Vector2 dir, Rectangle rect, float radius, float *t, bool *vertical) {
+    if (t == NULL || vertical == NULL) return false;
+
+    Rectangle expanded = {
+        rect.x - radius,
+        rect.y - radius,
+        rect.width + 2.0f * radius,
+        rect.height + 2.0f * radius,
+    };
+    if (!RayCastRect(origin, dir, expanded, t, vertical)) return false;
+
+    Vector2 point = {origin.x + dir.x * *t, origin.y + dir.y * *t};
+    Vector2 corner = {
+        Clamp(point.x, rect.x, rect.x + rect.width),
+        Clamp(point.y, rect.y, rect.y + rect.height),
+    };
+
+    // Hit a flat side
+    if (corner.x == point.x || corner.y == point.y) return true;
+
+    // Hit the corner region, intersect with the circle around the corner instead
+    Vector2 toOrigin = {origin.x - corner.x, origin.y - corner.y};
+    float a = dir.x * dir.x + dir.y * dir.y;
+    float b = dir.x * toOrigin.x + dir.y * toOrigin.y;
+    float c = toOrigin.x * toOrigin.x + toOrigin.y * toOrigin.y - radius * radius;
+    float discriminant = b * b - a * c;
+    if (discriminant < 0.0f) return false;
+
+    float cornerT = (-b - sqrtf(discriminant)) / a;
+    if (cornerT < 0.0f) return false;
+
+    // Bounce off the side the ball is further out from, like `BallHandleBrickCollision`
+    point = (Vector2){origin.x + dir.x * cornerT, origin.y + dir.y * cornerT};
+    *t = cornerT;
+    *vertical = fabsf(point.x - corner.x) > fabsf(point.y - corner.y);
+
+    return true;
+}
+
+void DrawPrediction(const Prediction *pred, const Ball *ball) {
+    if (pred == NULL) return;
+    if (ball == NULL) return;
+    if (!pred->found) return;
+
+    DrawCircleLinesV(pred->landing, (float)ball->radius, SKYBLUE);
+}
+
+int InitBroadcast(Broadcast *bc, const char *path) {
+    if (bc == NULL) return EINVAL;
+
+    memset(bc, 0, sizeof(*bc));
+    bc->fd = -1;
+
+    // No path means broadcast is disabled, updates are no-ops
+    if (path == NULL) return 0;
+
+#ifdef BROADCAST_SUPPORTED
+    struct sockaddr_un addr = {0};
+    addr.sun_family = AF_UNIX;
+    if (strlen(path) >= sizeof(addr.sun_path)) return ENAMETOOLONG;
+    strcpy(addr.sun_path, path);
+
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) return errno;
+
+    // Socket left behind by a host that didn't exit cleanly. Only remove it
+    // if nothing accepts connections on it, another host may still be running
+    struct stat st;
+    if (lstat(path, &st) == 0 && S_ISSOCK(st.st_mode)) {
+        int probe = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (probe >= 0 && connect(probe, (struct sockaddr *)&addr, sizeof(addr)) < 0 && errno == ECONNREFUSED) {
+            TraceLog(LOG_INFO, "BROADCAST: Removing stale socket %s", path);
+            unlink(path);
+        }
+        if (probe >= 0) close(probe);
+    }
+
+    // Never block the frame loop on accept
+    if (fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK) < 0 ||
+        bind(fd, (struct sockaddr *)&addr, sizeof(addr)) < 0 || listen(fd, MAX_VIEWERS) < 0) {
+        int err = errno;
+        TraceLog(LOG_WARNING, "BROADCAST: Failed to listen on %s: %s", path, strerror(err));
+        close(fd);
+        return err;
+    }
+
+#ifdef BROADCAST_IGNORE_SIGPIPE
+    signal(SIGPIPE, SIG_IGN);
+#endif
+
+    bc->fd = fd;
+    bc->path = path;
+    TraceLog(LOG_INFO, "BROADCAST: Listening on %s", path);
+
+    return 0;
+#else
+    TraceLog(LOG_WARNING, "BROADCAST: Not supported on this platform");
+    return ENOTSUP;
+#endif
+}
+
+void UpdateBroadcast(
+    Broadcast *bc,
+    const Player *player,
+    const Ball *ball,
+    const BrickWall *wall,
+    const GameState *state
+) {
+    if (bc == NULL) return;
+    if (bc->fd < 0) return;
+
+#ifdef BROADCAST_SUPPORTED
+    bc->tick++;
+
+    Snapshot *snap = &(bc->history[bc->tick % BROADCAST_HISTORY]);
+    CaptureSnapshot(snap, bc->tick, player, ball, wall, state);
+
+    BroadcastAcceptViewers(bc);
+
+    // Most viewers acknowledge the same tick, so every message is encoded
+    // once per tick and shared. Keyframe is needed to compare sizes anyway
+    uint8_t keyframe[BROADCAST_MESSAGE_SIZE];
+    size_t keyframeSize = bc->viewerCount > 0 ? EncodeSnapshot(keyframe, sizeof(keyframe), snap, NULL) : 0;
+
+    EncodedDelta deltas[BROADCAST_DELTA_CACHE];
+    int deltaCount = 0;
+    EncodedDelta uncached;
+
+    // One poll instead of a read per viewer, most have nothing to read
+    struct pollfd fds[MAX_VIEWERS];
+    for (int i = 0; i < bc->viewerCount; i++) {
+        fds[i] = (struct pollfd){bc->viewers[i].fd, POLLIN, 0};
+    }
+    if (poll(fds, bc->viewerCount, 0) < 0) {
+        for (int i = 0; i < bc->viewerCount; i++) {
+            fds[i].revents = POLLIN;
+        }
+    }
+
+    for (int i = 0; i < bc->viewerCount; i++) {
+        Viewer *viewer = &(bc->viewers[i]);
+
+        // Removing a viewer moves the last one into its place, keep `fds` in step
+        if (fds[i].revents != 0 && !BroadcastReadAcks(bc, viewer)) {
+            fds[i] = fds[bc->viewerCount - 1];
+            BroadcastRemoveViewer(bc, i--);
+            continue;
+        }
+
+        // Delta against the acknowledged tick if it is still in history, keyframe otherwise
+        const Snapshot *base = NULL;
+        if (viewer->acked && bc->tick - viewer->ackedTick < BROADCAST_HISTORY) {
+            base = &(bc->history[viewer->ackedTick % BROADCAST_HISTORY]);
+            if (base->tick != viewer->ackedTick) base = NULL;
+        }
+
+        const uint8_t *data = keyframe;
+        size_t size = keyframeSize;
+        if (base != NULL) {
+            int d = 0;
+            while (d < deltaCount && deltas[d].baseTick != base->tick) d++;
+
+            // Cache is full, encode without keeping it
+            EncodedDelta *delta = d < BROADCAST_DELTA_CACHE ? &(deltas[d]) : &uncached;
+            if (d == deltaCount) {
+                delta->baseTick = base->tick;
+                delta->size = EncodeSnapshot(delta->data, sizeof(delta->data), snap, base);
+                if (d < BROADCAST_DELTA_CACHE) deltaCount++;
+            }
+
+            // Many flipped bricks can make a delta larger than a keyframe
+            if (delta->size != 0 && delta->size < keyframeSize) {
+                data = delta->data;
+                size = delta->size;
+            }
+        }
+
+        // A viewer that can't take a whole message right away is too slow,
+        // drop it rather than buffering or blocking the frame loop
+        ssize_t sent = send(viewer->fd, data, size, MSG_DONTWAIT | MSG_NOSIGNAL);
+        if (sent < 0 || (size_t)sent != size) {
+            TraceLog(LOG_DEBUG, "BROADCAST: Dropping viewer %d", viewer->fd);
+            fds[i] = fds[bc->viewerCount - 1];
+            BroadcastRemoveViewer(bc, i--);
+        }
+    }
+#else
+    (void)player;
+    (void)ball;
+    (void)wall;
+    (void)state;
+#endif
+}
+
+void CloseBroadcast(Broadcast *bc) {
+    if (bc == NULL) return;
+    if (bc->fd < 0) return;
+
+#ifdef BROADCAST_SUPPORTED
+    for (int i = 0; i < bc->viewerCount; i++) {
+        close(bc->viewers[i].fd);
+    }
+    bc->viewerCount = 0;
+
+    close(bc->fd);
+    unlink(bc->path);
+#endif
+
+    bc->fd = -1;
+}
+
+void BroadcastAcceptViewers(Broadcast *bc) {
+    if (bc == NULL) return;
+
+#ifdef BROADCAST_SUPPORTED
+    for (;;) {
+        int fd = accept(bc->fd, NULL, NULL);
+        if (fd < 0) return;
+
+        if (bc->viewerCount == MAX_VIEWERS) {
+            close(fd);
+            continue;
+        }
+
+#ifdef SO_NOSIGPIPE
+        int noSigPipe = 1;
+        setsockopt(fd, SOL_SOCKET, SO_NOSIGPIPE, &noSigPipe, sizeof(noSigPipe));
+#endif
+        fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+
+        // Accepted during an update, current tick is the first one it receives
+        bc->viewers[bc->viewerCount++] = (Viewer){fd, bc->tick, 0, false, {0}, 0};
+        TraceLog(LOG_DEBUG, "BROADCAST: Viewer %d connected", fd);
+    }
+#endif
+}
+
+bool BroadcastReadAcks(Broadcast *bc, Viewer *viewer) {
+    if (bc == NULL) return false;
+    if (viewer == NULL) return false;
+
+#ifdef BROADCAST_SUPPORTED
+    // Acknowledgements are little-endian u32 ticks, only the latest one matters
+    uint8_t buffer[64];
+    for (;;) {
+        ssize_t received = recv(viewer->fd, buffer, sizeof(buffer), MSG_DONTWAIT);
+        if (received == 0) return false;
+        if (received < 0) return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;
+
+        for (ssize_t i = 0; i < received; i++) {
+            viewer->ack[viewer->ackSize++] = buffer[i];
+            if (viewer->ackSize < 4) continue;
+
+            uint32_t tick = (uint32_t)viewer->ack[0] | (uint32_t)viewer->ack[1] << 8 |
+                            (uint32_t)viewer->ack[2] << 16 | (uint32_t)viewer->ack[3] << 24;
+            viewer->ackSize = 0;
+
+            // Ignore acknowledgements of ticks that were never sent to this viewer.
+            // Ticks start at 1, and the current one is sent only after
+            // acknowledgements are read. A reconnecting viewer may ack ticks from
+            // its previous connection, those are before `firstTick`
+            if (tick == 0 || tick < viewer->firstTick || tick >= bc->tick) continue;
+
+            viewer->ackedTick = tick;
+            viewer->acked = true;
+        }
+    }
+#else
+    return false;
+#endif
+}
+
+void BroadcastRemoveViewer(Broadcast *bc, int index) {
+    if (bc == NULL) return;
+    if (index < 0 || index >= bc->viewerCount) return;
+
+#ifdef BROADCAST_SUPPORTED
+    close(bc->viewers[index].fd);
+#endif
+
+    // Order of viewers doesn't matter, move the last one into the gap
+    bc->viewers[index] = bc->viewers[--bc->viewerCount];
+}
+
+void CaptureSnapshot(
+    Snapshot *snap,
+    uint32_t tick,
+    const Player *player,
+    const Ball *ball,
+    const BrickWall *wall,
+    const GameState *state
+) {
+    if (snap == NULL) return;
+
+    memset(snap, 0, sizeof(*snap));
+    snap->tick = tick;
+
+    if (player != NULL) {
+        snap->player = player->rect;
+        snap->lives = player->lives;
+    }
+
+    if (ball != NULL) {
+        snap->ballPos = ball->pos;
+        snap->ballVelocity = ball->velocity;
+    }
+
+    if (wall != NULL) {
+        for (int r = 0; r < BRICK_VCOUNT; r++) {
+            for (int c = 0; c < BRICK_HCOUNT; c++) {
+                if (!wall->bricks[r][c].enabled) continue;
+
+                int index = r * BRICK_HCOUNT + c;
+                snap->bricks[index / 8] |= 1 << (index % 8);
+            }
+        }
+    }
+
+    if (state != NULL) {
+        snap->points = state->points;
+        snap->gameOver = state->gameOver;
+    }
+}
+
+// Message layout, bit-packed MSB first after a little-endian u16 payload size:
+//  - keyframe: 1 bit (0), u32 tick, all fields, 104-bit brick bitmap
+//  - delta: 1 bit (1), u32 tick, u32 base tick, 11-bit mask of changed fields,
+//    changed fields, and if bricks changed: 7-bit count + 7-bit index of each flipped brick
+// Fields in order: player x/y/width/height, ball x/y, velocity x/y (f32),
+// points, lives (i32), game over (1 bit)
+size_t EncodeSnapshot(uint8_t *buffer, size_t size, const Snapshot *snap, const Snapshot *base) {
+    if (buffer == NULL) return 0;
+    if (snap == NULL) return 0;
+    if (size < 2) return 0;
+
+    BitWriter writer = {buffer + 2, size - 2, 0};
+
+    float fields[8] = {
+        snap->player.x,
+        snap->player.y,
+        snap->player.width,
+        snap->player.height,
+        snap->ballPos.x,
+        snap->ballPos.y,
+        snap->ballVelocity.x,
+        snap->ballVelocity.y,
+    };
+
+    WriteBits(&writer, base != NULL, 1);
+    WriteBits(&writer, snap->tick, 32);
+
+    if (base == NULL) {
+        for (int i = 0; i < 8; i++) {
+            WriteFloatBits(&writer, fields[i]);
+        }
+        WriteBits(&writer, (uint32_t)snap->points, 32);
+        WriteBits(&writer, (uint32_t)snap->lives, 32);
+        WriteBits(&writer, snap->gameOver, 1);
+
+        for (int i = 0; i < BRICK_HCOUNT * BRICK_VCOUNT; i++) {
+            WriteBits(&writer, (snap->bricks[i / 8] >> (i % 8)) & 1, 1);
+        }
+    } else {
+        float baseFields[8] = {
+            base->player.x,
+            base->player.y,
+            base->player.width,
+            base->player.height,
+            base->ballPos.x,
+            base->ballPos.y,
+            base->ballVelocity.x,
+            base->ballVelocity.y,
+        };
+
+        int flipped = 0;
+        for (int i = 0; i < BRICK_BITMAP_SIZE; i++) {
+            for (uint8_t diff = snap->bricks[i] ^ base->bricks[i]; diff != 0; diff &= diff - 1) {
+                flipped++;
+            }
+        }
+
+        // Compare bit patterns so the mask matches what a viewer decodes exactly
+        uint32_t mask = 0;
+        for (int i = 0; i < 8; i++) {
+            if (memcmp(&fields[i], &baseFields[i], sizeof(float)) != 0) mask |= 1u << i;
+        }
+        if (snap->points != base->points) mask |= 1u << 8;
+        if (snap->lives != base->lives) mask |= 1u << 9;
+        if (flipped != 0) mask |= 1u << 10;
+
+        WriteBits(&writer, base->tick, 32);
+        WriteBits(&writer, mask, 11);
+
+        for (int i = 0; i < 8; i++) {
+            if (mask & (1u << i)) WriteFloatBits(&writer, fields[i]);
+        }
+        if (mask & (1u << 8)) WriteBits(&writer, (uint32_t)snap->points, 32);
+        if (mask & (1u << 9)) WriteBits(&writer, (uint32_t)snap->lives, 32);
+        WriteBits(&writer, snap->gameOver, 1);
+
+        if (mask & (1u << 10)) {
+            WriteBits(&writer, flipped, BRICK_INDEX_BITS);
+            for (int i = 0; i < BRICK_HCOUNT * BRICK_VCOUNT; i++) {
+                if (((snap->bricks[i / 8] ^ base->bricks[i / 8]) >> (i % 8)) & 1) {
+                    WriteBits(&writer, i, BRICK_INDEX_BITS);
+                }
+            }
+        }
+    }
+
+    if (writer.bits > writer.capacity * 8) return 0;
+
+    size_t payload = (writer.bits + 7) / 8;
+    buffer[0] = payload & 0xff;
+    buffer[1] = (payload >> 8) & 0xff;
+
+    return payload + 2;
+}
+
+void WriteBits(BitWriter *writer, uint32_t value, int count) {
+    if (writer == NULL) return;
+
+    for (int i = count - 1; i >= 0; i--, writer->bits++) {
+        // Keep counting past the end so the caller can detect overflow
+        if (writer->bits >= writer->capacity * 8) continue;
+
+        // Bytes are cleared as they are started, buffers don't need to be zeroed
+        uint8_t *byte = &(writer->data[writer->bits / 8]);
+        if (writer->bits % 8 == 0) *byte = 0;
+        if ((value >> i) & 1) *byte |= 0x80 >> (writer->bits % 8);
+    }
+}
+
+void WriteFloatBits(BitWriter *writer, float value) {
+    uint32_t bits = 0;
+    memcpy(&bits, &value, sizeof(bits));
+
+    WriteBits(writer, bits, 32);
+}
+
+void InstallStopHandlers(void) {
+#ifdef BROADCAST_SUPPORTED
+    // Handler stays installed after the first signal, and without SA_RESTART
+    // the frame sleep is interrupted so the loop notices the stop right away
+    struct sigaction action = {0};
+    action.sa_handler = HandleStopSignal;
+    action.sa_flags = 0;
+    sigemptyset(&action.sa_mask);
+
+    sigaction(SIGINT, &action, NULL);
+    sigaction(SIGTERM, &action, NULL);
+#endif
+}
+
+void HandleStopSignal(int sig) {
+    (void)sig;
+
+    stopRequested = 1;
+}
+
+void WaitHeadlessFrame(void) {
+#ifdef BROADCAST_SUPPORTED
+    struct timespec frame = {0, (long)(HEADLESS_DELTA_TIME * 1e9f)};
+    nanosleep(&frame, NULL);
+#endif
+}
@@ -0,0 +1,390 @@
+// Stand-in spectator client for the broadcast server. Viewers connect over a
+// Unix socket, decode every message (see `EncodeSnapshot` for the layout),
+// acknowledge it and check the decoded state matches what the host captured.
+#include "../breakout.c"
+
+#define TEST_VIEWERS 200
+#define TEST_TICKS 120
+
+#define CHECK(cond)                                                                                                    \
+    do {                                                                                                               \
+        if (!(cond)) {                                                                                                 \
+            fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond);                                  \
+            failures++;                                                                                                \
+        }                                                                                                              \
+    } while (0)
+
+typedef struct BitReader {
+    const uint8_t *data;
+    size_t size;
+    size_t bits;
+} BitReader;
+
+typedef struct TestViewer {
+    int fd;
+    Snapshot received[BROADCAST_HISTORY]; // indexed like `Broadcast.history`
+    Snapshot last;
+    bool keyframe;
+} TestViewer;
+
+typedef struct TestGame {
+    GameState state;
+    Player player;
+    Ball ball;
+    BrickWall wall;
+} TestGame;
+
+static int failures = 0;
+
+static uint32_t ReadBits(BitReader *reader, int count) {
+    uint32_t value = 0;
+
+    for (int i = 0; i < count; i++, reader->bits++) {
+        if (reader->bits >= reader->size * 8) return 0;
+
+        uint8_t bit = (reader->data[reader->bits / 8] >> (7 - reader->bits % 8)) & 1;
+        value = value << 1 | bit;
+    }
+
+    return value;
+}
+
+static float ReadFloatBits(BitReader *reader) {
+    uint32_t bits = ReadBits(reader, 32);
+    float value = 0.0f;
+    memcpy(&value, &bits, sizeof(value));
+
+    return value;
+}
+
+static void SetFields(Snapshot *snap, const float fields[8]) {
+    snap->player = (Rectangle){fields[0], fields[1], fields[2], fields[3]};
+    snap->ballPos = (Vector2){fields[4], fields[5]};
+    snap->ballVelocity = (Vector2){fields[6], fields[7]};
+}
+
+static void GetFields(const Snapshot *snap, float fields[8]) {
+    float values[8] = {
+        snap->player.x,
+        snap->player.y,
+        snap->player.width,
+        snap->player.height,
+        snap->ballPos.x,
+        snap->ballPos.y,
+        snap->ballVelocity.x,
+        snap->ballVelocity.y,
+    };
+
+    memcpy(fields, values, sizeof(values));
+}
+
+static bool DecodeMessage(TestViewer *viewer, const uint8_t *payload, size_t size) {
+    BitReader reader = {payload, size, 0};
+    Snapshot snap = {0};
+    float fields[8] = {0};
+
+    viewer->keyframe = ReadBits(&reader, 1) == 0;
+    uint32_t tick = ReadBits(&reader, 32);
+
+    if (viewer->keyframe) {
+        for (int i = 0; i < 8; i++) {
+            fields[i] = ReadFloatBits(&reader);
+        }
+        snap.points = (int32_t)ReadBits(&reader, 32);
+        snap.lives = (int32_t)ReadBits(&reader, 32);
+        snap.gameOver = ReadBits(&reader, 1);
+
+        for (int i = 0; i < BRICK_HCOUNT * BRICK_VCOUNT; i++) {
+            if (ReadBits(&reader, 1)) snap.bricks[i / 8] |= 1 << (i % 8);
+        }
+    } else {
+        uint32_t baseTick = ReadBits(&reader, 32);
+        const Snapshot *base = &(viewer->received[baseTick % BROADCAST_HISTORY]);
+        if (baseTick == 0 || base->tick != baseTick) return false;
+
+        snap = *base;
+        GetFields(base, fields);
+
+        uint32_t mask = ReadBits(&reader, 11);
+        for (int i = 0; i < 8; i++) {
+            if (mask & (1u << i)) fields[i] = ReadFloatBits(&reader);
+        }
+        if (mask & (1u << 8)) snap.points = (int32_t)ReadBits(&reader, 32);
+        if (mask & (1u << 9)) snap.lives = (int32_t)ReadBits(&reader, 32);
+        snap.gameOver = ReadBits(&reader, 1);
+
+        if (mask & (1u << 10)) {
+            int flipped = ReadBits(&reader, BRICK_INDEX_BITS);
+            for (int i = 0; i < flipped; i++) {
+                int index = ReadBits(&reader, BRICK_INDEX_BITS);
+                snap.bricks[index / 8] ^= 1 << (index % 8);
+            }
+        }
+    }
+
+    if (reader.bits > size * 8) return false;
+
+    snap.tick = tick;
+    SetFields(&snap, fields);
+    viewer->received[tick % BROADCAST_HISTORY] = snap;
+    viewer->last = snap;
+
+    return true;
+}
+
+static bool ReadExact(int fd, uint8_t *buffer, size_t size) {
+    for (size_t done = 0; done < size;) {
+        ssize_t received = recv(fd, buffer + done, size - done, 0);
+        if (received <= 0) return false;
+
+        done += received;
+    }
+
+    return true;
+}
+
+// Reads and decodes one message, returns its size including the length prefix
+static size_t ReceiveMessage(TestViewer *viewer) {
+    uint8_t header[2];
+    if (!ReadExact(viewer->fd, header, sizeof(header))) return 0;
+
+    size_t size = header[0] | header[1] << 8;
+    uint8_t payload[BROADCAST_MESSAGE_SIZE];
+    if (size > sizeof(payload) || !ReadExact(viewer->fd, payload, size)) return 0;
+    if (!DecodeMessage(viewer, payload, size)) return 0;
+
+    return size + 2;
+}
+
+static void SendAck(const TestViewer *viewer, uint32_t tick) {
+    uint8_t ack[4] = {tick & 0xff, (tick >> 8) & 0xff, (tick >> 16) & 0xff, (tick >> 24) & 0xff};
+    send(viewer->fd, ack, sizeof(ack), MSG_NOSIGNAL);
+}
+
+static int ConnectViewer(TestViewer *viewer, const char *path) {
+    memset(viewer, 0, sizeof(*viewer));
+
+    struct sockaddr_un addr = {0};
+    addr.sun_family = AF_UNIX;
+    strcpy(addr.sun_path, path);
+
+    viewer->fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (viewer->fd < 0) return errno;
+    if (connect(viewer->fd, (struct sockaddr *)&addr, sizeof(addr)) < 0) return errno;
+
+    return 0;
+}
+
+static bool SnapshotsEqual(const Snapshot *a, const Snapshot *b) {
+    float fieldsA[8];
+    float fieldsB[8];
+    GetFields(a, fieldsA);
+    GetFields(b, fieldsB);
+
+    return a->tick == b->tick && memcmp(fieldsA, fieldsB, sizeof(fieldsA)) == 0 &&
+           memcmp(a->bricks, b->bricks, sizeof(a->bricks)) == 0 && a->points == b->points && a->lives == b->lives &&
+           a->gameOver == b->gameOver;
+}
+
+static void InitTestGame(TestGame *game) {
+    InitGameState(&game->state);
+    InitPlayer(&game->player);
+    InitBall(&game->ball, &game->player);
+    InitBrickWall(&game->wall);
+    LaunchBall(&game->ball);
+}
+
+static void StepTestGame(TestGame *game, int tick) {
+    UpdateBall(&game->ball, &game->player, &game->wall, &game->state, HEADLESS_DELTA_TIME);
+    game->player.rect.x = 300.0f + tick % 50;
+
+    // Destroy a brick now and then so deltas carry brick changes
+    if (tick % 10 == 0) {
+        Brick *brick = &(game->wall.bricks[tick / 10 % BRICK_VCOUNT][tick % BRICK_HCOUNT]);
+        if (brick->enabled) {
+            brick->enabled = false;
+            game->wall.remaining--;
+            game->state.points++;
+        }
+    }
+}
+
+static void BroadcastTick(Broadcast *bc, TestGame *game) {
+    UpdateBroadcast(bc, &game->player, &game->ball, &game->wall, &game->state);
+}
+
+static const Snapshot *HostSnapshot(const Broadcast *bc) {
+    return &(bc->history[bc->tick % BROADCAST_HISTORY]);
+}
+
+// Viewers that acknowledge every message get deltas that decode to the host state
+static void TestDeltaStream(const char *path) {
+    Broadcast bc;
+    CHECK(InitBroadcast(&bc, path) == 0);
+
+    static TestViewer viewers[TEST_VIEWERS];
+    for (int v = 0; v < TEST_VIEWERS; v++) {
+        CHECK(ConnectViewer(&viewers[v], path) == 0);
+    }
+
+    TestGame game;
+    InitTestGame(&game);
+
+    size_t bytes = 0;
+    int keyframes = 0;
+    for (int t = 1; t <= TEST_TICKS; t++) {
+        StepTestGame(&game, t);
+        BroadcastTick(&bc, &game);
+        CHECK(bc.viewerCount == TEST_VIEWERS);
+
+        for (int v = 0; v < TEST_VIEWERS; v++) {
+            size_t size = ReceiveMessage(&viewers[v]);
+            CHECK(size != 0);
+            CHECK(SnapshotsEqual(&viewers[v].last, HostSnapshot(&bc)));
+
+            if (v == 0) {
+                bytes += size;
+                keyframes += viewers[v].keyframe;
+            }
+
+            SendAck(&viewers[v], bc.tick);
+        }
+    }
+
+    // Only the first message needs to be a keyframe
+    CHECK(keyframes == 1);
+    printf(
+        "delta stream: %zu bytes over %d ticks (%.0f B/s at 60 FPS)\n",
+        bytes,
+        TEST_TICKS,
+        bytes * 60.0 / TEST_TICKS
+    );
+
+    for (int v = 0; v < TEST_VIEWERS; v++) {
+        close(viewers[v].fd);
+    }
+    CloseBroadcast(&bc);
+}
+
+// Ticks that were never sent can't be used as delta bases
+static void TestInvalidAcks(const char *path) {
+    Broadcast bc;
+    CHECK(InitBroadcast(&bc, path) == 0);
+
+    TestViewer viewer;
+    CHECK(ConnectViewer(&viewer, path) == 0);
+
+    TestGame game;
+    InitTestGame(&game);
+
+    BroadcastTick(&bc, &game);
+    CHECK(ReceiveMessage(&viewer) != 0);
+    CHECK(viewer.keyframe);
+
+    // Tick 0 is never sent, and history slot 0 is still empty
+    SendAck(&viewer, 0);
+    BroadcastTick(&bc, &game);
+    CHECK(ReceiveMessage(&viewer) != 0);
+    CHECK(viewer.keyframe);
+
+    // Next tick hasn't been sent yet
+    SendAck(&viewer, bc.tick + 1);
+    BroadcastTick(&bc, &game);
+    CHECK(ReceiveMessage(&viewer) != 0);
+    CHECK(viewer.keyframe);
+
+    SendAck(&viewer, bc.tick);
+    BroadcastTick(&bc, &game);
+    CHECK(ReceiveMessage(&viewer) != 0);
+    CHECK(!viewer.keyframe);
+    CHECK(SnapshotsEqual(&viewer.last, HostSnapshot(&bc)));
+
+    // Reconnecting viewer acknowledging the last tick of its previous
+    // connection never received it on this one
+    uint32_t lastTick = bc.tick;
+    close(viewer.fd);
+    CHECK(ConnectViewer(&viewer, path) == 0);
+
+    BroadcastTick(&bc, &game);
+    CHECK(ReceiveMessage(&viewer) != 0);
+    CHECK(viewer.keyframe);
+
+    SendAck(&viewer, lastTick);
+    BroadcastTick(&bc, &game);
+    CHECK(ReceiveMessage(&viewer) != 0);
+    CHECK(viewer.keyframe);
+
+    close(viewer.fd);
+    CloseBroadcast(&bc);
+}
+
+// Delta flipping most bricks is larger than a keyframe, keyframe is sent instead
+static void TestLargeDeltaSendsKeyframe(const char *path) {
+    Broadcast bc;
+    CHECK(InitBroadcast(&bc, path) == 0);
+
+    TestViewer viewer;
+    CHECK(ConnectViewer(&viewer, path) == 0);
+
+    TestGame game;
+    InitTestGame(&game);
+
+    BroadcastTick(&bc, &game);
+    CHECK(ReceiveMessage(&viewer) != 0);
+    SendAck(&viewer, bc.tick);
+
+    for (int r = 0; r < BRICK_VCOUNT; r++) {
+        for (int c = 0; c < BRICK_HCOUNT; c++) {
+            game.wall.bricks[r][c].enabled = false;
+        }
+    }
+
+    BroadcastTick(&bc, &game);
+    size_t size = ReceiveMessage(&viewer);
+    CHECK(size != 0 && size <= BROADCAST_MESSAGE_SIZE);
+    CHECK(viewer.keyframe);
+    CHECK(SnapshotsEqual(&viewer.last, HostSnapshot(&bc)));
+
+    close(viewer.fd);
+    CloseBroadcast(&bc);
+}
+
+// A socket file left by a host that didn't close is replaced
+static void TestStaleSocket(const char *path) {
+    Broadcast crashed;
+    CHECK(InitBroadcast(&crashed, path) == 0);
+
+    // Simulate a crash, the socket file stays behind
+    close(crashed.fd);
+
+    Broadcast bc;
+    CHECK(InitBroadcast(&bc, path) == 0);
+
+    // A live host's socket is left alone
+    Broadcast other;
+    CHECK(InitBroadcast(&other, path) == EADDRINUSE);
+
+    CloseBroadcast(&bc);
+}
+
+int main(void) {
+    SetTraceLogLevel(LOG_WARNING);
+
+    char path[64];
+    snprintf(path, sizeof(path), "/tmp/breakout-test-%ld.sock", (long)getpid());
+    unlink(path);
+
+    TestDeltaStream(path);
+    TestInvalidAcks(path);
+    TestLargeDeltaSendsKeyframe(path);
+    TestStaleSocket(path);
+
+    unlink(path);
+
+    if (failures != 0) {
+        fprintf(stderr, "%d checks failed\n", failures);
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,102 @@
+// Broad-phase benchmark: balls spread over the arena, jittering a little every
+// frame, timing `UpdateBroadPhase` + `BroadPhaseForEachPair` per frame.
+// Pairs are checked against brute force before timing.
+//
+// Usage: broadphase_bench [bodies...], defaults to 500 1000 2000 3000
+#include "../breakout.c"
+
+#include <time.h>
+
+#define BENCH_FRAMES 200
+#define BENCH_BALL_RADIUS 4
+
+static int pairCount = 0;
+
+static void CountPair(Body *a, Body *b, void *ctx) {
+    (void)a;
+    (void)b;
+    (void)ctx;
+
+    pairCount++;
+}
+
+static float RandomFloat(float max) {
+    return (float)rand() / (float)RAND_MAX * max;
+}
+
+static int RunBenchmark(int count) {
+    Ball *balls = (Ball *)calloc(count, sizeof(Ball));
+    if (balls == NULL) return ENOMEM;
+
+    BroadPhase bp;
+    if (InitBroadPhase(&bp, count) != 0) return ENOMEM;
+
+    srand(1);
+    for (int i = 0; i < count; i++) {
+        balls[i].radius = BENCH_BALL_RADIUS;
+        balls[i].pos = (Vector2){RandomFloat(SCREEN_WIDTH), RandomFloat(SCREEN_HEIGHT)};
+        balls[i].prevPos = balls[i].pos;
+        balls[i].velocity = (Vector2){1.0f, 0.0f};
+        balls[i].speed = BALL_SPEED;
+        balls[i].enabled = true;
+
+        BroadPhaseAdd(&bp, BODY_BALL, &balls[i]);
+    }
+
+    UpdateBroadPhase(&bp);
+
+    int expected = 0;
+    for (int i = 0; i < count; i++) {
+        for (int j = i + 1; j < count; j++) {
+            if (CheckCollisionCircles(balls[i].prevPos, BENCH_BALL_RADIUS, balls[j].prevPos, BENCH_BALL_RADIUS)) {
+                expected++;
+            }
+        }
+    }
+
+    pairCount = 0;
+    BroadPhaseForEachPair(&bp, &CountPair, NULL);
+    if (pairCount != expected) {
+        fprintf(stderr, "%d bodies: broad-phase found %d pairs, brute force %d\n", count, pairCount, expected);
+        return 1;
+    }
+
+    clock_t elapsed = 0;
+    for (int f = 0; f < BENCH_FRAMES; f++) {
+        // Small moves keep the order nearly sorted, as between real frames
+        for (int i = 0; i < count; i++) {
+            balls[i].prevPos.x += RandomFloat(4.0f) - 2.0f;
+            balls[i].prevPos.y += RandomFloat(4.0f) - 2.0f;
+        }
+
+        clock_t start = clock();
+        UpdateBroadPhase(&bp);
+        BroadPhaseForEachPair(&bp, &HandleBodyCollision, NULL);
+        elapsed += clock() - start;
+    }
+
+    double ms = 1000.0 * elapsed / CLOCKS_PER_SEC / BENCH_FRAMES;
+    printf("%5d bodies: %6.3f ms/frame, %d pairs\n", count, ms, expected);
+
+    CloseBroadPhase(&bp);
+    free(balls);
+
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    int defaults[] = {500, 1000, 2000, 3000};
+
+    if (argc > 1) {
+        for (int i = 1; i < argc; i++) {
+            if (RunBenchmark(atoi(argv[i])) != 0) return 1;
+        }
+        return 0;
+    }
+
+    for (size_t i = 0; i < sizeof(defaults) / sizeof(defaults[0]); i++) {
+        if (RunBenchmark(defaults[i]) != 0) return 1;
+    }
+
+    return 0;
+}
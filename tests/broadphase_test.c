@@ -0,0 +1,216 @@
+// Broad-phase correctness: sweep pairs against brute force with balls and
+// players mixed, and collisions resolved through the sweep like in the game.
+#include "../breakout.c"
+
+#define TEST_BALLS 300
+#define TEST_PLAYERS 20
+#define TEST_BODIES (TEST_BALLS + TEST_PLAYERS)
+
+#define CHECK(cond)                                                                                                    \
+    do {                                                                                                               \
+        if (!(cond)) {                                                                                                 \
+            fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond);                                  \
+            failures++;                                                                                                \
+        }                                                                                                              \
+    } while (0)
+
+typedef struct PairSet {
+    void *objects[TEST_BODIES];
+    bool found[TEST_BODIES][TEST_BODIES];
+    int count;
+} PairSet;
+
+static int failures = 0;
+
+static float RandomFloat(float max) {
+    return (float)rand() / (float)RAND_MAX * max;
+}
+
+static int ObjectIndex(const PairSet *pairs, const void *object) {
+    for (int i = 0; i < TEST_BODIES; i++) {
+        if (pairs->objects[i] == object) return i;
+    }
+
+    return -1;
+}
+
+static void RecordPair(Body *a, Body *b, void *ctx) {
+    PairSet *pairs = (PairSet *)ctx;
+
+    int i = ObjectIndex(pairs, a->object);
+    int j = ObjectIndex(pairs, b->object);
+    if (i < 0 || j < 0) return;
+
+    // Each pair must be reported once
+    if (pairs->found[i][j] || pairs->found[j][i]) failures++;
+
+    pairs->found[i][j] = true;
+    pairs->found[j][i] = true;
+    pairs->count++;
+}
+
+static void CheckAgainstBruteForce(const BroadPhase *bp, PairSet *pairs) {
+    memset(pairs->found, 0, sizeof(pairs->found));
+    pairs->count = 0;
+
+    BroadPhaseForEachPair(bp, &RecordPair, pairs);
+
+    int expected = 0;
+    for (int i = 0; i < bp->count; i++) {
+        for (int j = i + 1; j < bp->count; j++) {
+            const Body *a = &(bp->bodies[i]);
+            const Body *b = &(bp->bodies[j]);
+            if (!CheckCollisionBodies(a, b)) continue;
+
+            expected++;
+            CHECK(pairs->found[ObjectIndex(pairs, a->object)][ObjectIndex(pairs, b->object)]);
+        }
+    }
+
+    CHECK(pairs->count == expected);
+}
+
+// Sweep finds the same pairs as testing every pair, also after removals
+static void TestPairsMatchBruteForce(void) {
+    static Ball balls[TEST_BALLS];
+    static Player players[TEST_PLAYERS];
+    static PairSet pairs;
+
+    BroadPhase bp;
+    CHECK(InitBroadPhase(&bp, 4) == 0);
+
+    srand(7);
+    for (int i = 0; i < TEST_PLAYERS; i++) {
+        InitPlayer(&players[i]);
+        players[i].rect.x = RandomFloat(SCREEN_WIDTH);
+        players[i].rect.y = RandomFloat(SCREEN_HEIGHT);
+
+        pairs.objects[i] = &players[i];
+        CHECK(BroadPhaseAdd(&bp, BODY_PLAYER, &players[i]) == 0);
+    }
+
+    for (int i = 0; i < TEST_BALLS; i++) {
+        InitBall(&balls[i], &players[0]);
+        balls[i].pos = (Vector2){RandomFloat(SCREEN_WIDTH), RandomFloat(SCREEN_HEIGHT)};
+        balls[i].prevPos = balls[i].pos;
+        // Disabled balls never collide, keep a few of them around
+        balls[i].enabled = i % 10 != 0;
+
+        pairs.objects[TEST_PLAYERS + i] = &balls[i];
+        CHECK(BroadPhaseAdd(&bp, BODY_BALL, &balls[i]) == 0);
+    }
+
+    UpdateBroadPhase(&bp);
+    for (int i = 1; i < bp.count; i++) {
+        CHECK(bp.bodies[i - 1].minX <= bp.bodies[i].minX);
+    }
+    CheckAgainstBruteForce(&bp, &pairs);
+    CHECK(pairs.count > 0);
+
+    // Move everything a bit, as between frames
+    for (int i = 0; i < TEST_BALLS; i++) {
+        balls[i].prevPos.x += RandomFloat(20.0f) - 10.0f;
+        balls[i].prevPos.y += RandomFloat(20.0f) - 10.0f;
+    }
+    for (int i = 0; i < TEST_PLAYERS; i++) {
+        players[i].rect.x += RandomFloat(20.0f) - 10.0f;
+    }
+
+    UpdateBroadPhase(&bp);
+    CheckAgainstBruteForce(&bp, &pairs);
+
+    // Removed bodies are no longer reported
+    for (int i = 0; i < TEST_BALLS; i += 3) {
+        CHECK(BroadPhaseRemove(&bp, &balls[i]) == 0);
+    }
+    CHECK(BroadPhaseRemove(&bp, &balls[0]) == ENOENT);
+    CHECK(BroadPhaseRemove(&bp, &players[0]) == 0);
+    CHECK(bp.count == TEST_BODIES - (TEST_BALLS + 2) / 3 - 1);
+
+    UpdateBroadPhase(&bp);
+    CheckAgainstBruteForce(&bp, &pairs);
+    for (int i = 0; i < TEST_BODIES; i++) {
+        CHECK(!pairs.found[ObjectIndex(&pairs, &players[0])][i]);
+        CHECK(!pairs.found[ObjectIndex(&pairs, &balls[3])][i]);
+    }
+
+    CloseBroadPhase(&bp);
+    CHECK(bp.bodies == NULL && bp.count == 0);
+}
+
+// Ball falling onto the player bounces through the sweep, as in the game loop
+static void TestBallBouncesOffPlayer(void) {
+    Player player;
+    InitPlayer(&player);
+
+    Ball ball;
+    InitBall(&ball, &player);
+    LaunchBall(&ball);
+    ball.pos = (Vector2){PlayerBottomMid(&player).x, player.rect.y - ball.radius + 1.0f};
+    ball.prevPos = ball.pos;
+    ball.velocity = (Vector2){0.0f, 1.0f};
+
+    BroadPhase bp;
+    CHECK(InitBroadPhase(&bp, 2) == 0);
+    CHECK(BroadPhaseAdd(&bp, BODY_BALL, &ball) == 0);
+    CHECK(BroadPhaseAdd(&bp, BODY_PLAYER, &player) == 0);
+
+    UpdateBroadPhase(&bp);
+    BroadPhaseForEachPair(&bp, &HandleBodyCollision, NULL);
+
+    CHECK(ball.velocity.y < 0.0f);
+    CHECK(ball.speed == BALL_SPEED + 5.0f);
+
+    CloseBroadPhase(&bp);
+}
+
+// Balls moving into each other are reflected and pushed apart
+static void TestBallsBounceOffEachOther(void) {
+    Player player;
+    InitPlayer(&player);
+
+    Ball a;
+    Ball b;
+    InitBall(&a, &player);
+    InitBall(&b, &player);
+    LaunchBall(&a);
+    LaunchBall(&b);
+
+    a.pos = (Vector2){200.0f, 200.0f};
+    b.pos = (Vector2){200.0f + 2.0f * BALL_RADIUS - 2.0f, 200.0f};
+    a.prevPos = a.pos;
+    b.prevPos = b.pos;
+    a.velocity = (Vector2){1.0f, 0.0f};
+    b.velocity = (Vector2){-1.0f, 0.0f};
+
+    BroadPhase bp;
+    CHECK(InitBroadPhase(&bp, 2) == 0);
+    CHECK(BroadPhaseAdd(&bp, BODY_BALL, &a) == 0);
+    CHECK(BroadPhaseAdd(&bp, BODY_BALL, &b) == 0);
+
+    UpdateBroadPhase(&bp);
+    BroadPhaseForEachPair(&bp, &HandleBodyCollision, NULL);
+
+    CHECK(a.velocity.x < 0.0f);
+    CHECK(b.velocity.x > 0.0f);
+    CHECK(fabsf(a.velocity.x * a.velocity.x + a.velocity.y * a.velocity.y - 1.0f) < 0.01f);
+    CHECK(fabsf(b.velocity.x * b.velocity.x + b.velocity.y * b.velocity.y - 1.0f) < 0.01f);
+    CHECK(b.pos.x - a.pos.x >= 2.0f * BALL_RADIUS - 0.01f);
+
+    CloseBroadPhase(&bp);
+}
+
+int main(void) {
+    SetTraceLogLevel(LOG_WARNING);
+
+    TestPairsMatchBruteForce();
+    TestBallBouncesOffPlayer();
+    TestBallsBounceOffEachOther();
+
+    if (failures != 0) {
+        fprintf(stderr, "%d checks failed\n", failures);
+        return 1;
+    }
+
+    return 0;
+}
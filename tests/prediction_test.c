@@ -0,0 +1,87 @@
+// Landing prediction accuracy: launches the ball at random angles and
+// positions, runs `UpdateBall` until it reaches the player and checks the
+// cached prediction against where it actually got there.
+#include "../breakout.c"
+
+#include <time.h>
+
+#define TEST_LAUNCHES 200
+#define TEST_MAX_FRAMES 3000
+#define TEST_DELTA_TIME (1.0f / 60.0f)
+
+// Discrete collision handling snaps the ball to walls and bricks, so the
+// simulated path can be off from the exact one by a few pixels
+#define LANDING_TOLERANCE 6.0f
+
+int main(void) {
+    SetTraceLogLevel(LOG_WARNING);
+    srand(3);
+
+    int landings = 0;
+    int accurate = 0;
+    int rebuilds = 0;
+    long frames = 0;
+    clock_t elapsed = 0;
+
+    for (int launch = 0; launch < TEST_LAUNCHES; launch++) {
+        GameState state;
+        Player player;
+        Ball ball;
+        BrickWall wall;
+        InitGameState(&state);
+        InitPlayer(&player);
+        InitBall(&ball, &player);
+        InitBrickWall(&wall);
+
+        // Up to ~63 degrees either side of straight up
+        float angle = ((float)rand() / RAND_MAX - 0.5f) * 2.2f;
+        ball.pos.x = 100.0f + rand() % 600;
+        ball.prevPos = ball.pos;
+        LaunchBall(&ball);
+        ball.speed = 300.0f;
+        ball.velocity = (Vector2){sinf(angle), -cosf(angle)};
+
+        Prediction pred = {0};
+        float landingY = player.rect.y - ball.radius;
+
+        for (int f = 0; f < TEST_MAX_FRAMES; f++) {
+            Vector2 origin = pred.origins[0];
+            bool wasValid = pred.valid;
+
+            clock_t start = clock();
+            UpdatePrediction(&pred, &ball, &player, &wall, TEST_DELTA_TIME);
+            elapsed += clock() - start;
+            frames++;
+
+            if (!wasValid || origin.x != pred.origins[0].x || origin.y != pred.origins[0].y) rebuilds++;
+
+            Vector2 prev = ball.pos;
+            UpdateBall(&ball, &player, &wall, &state, TEST_DELTA_TIME);
+            if (prev.y >= landingY || ball.pos.y < landingY || ball.velocity.y <= 0.0f) continue;
+
+            // Interpolate where the ball crossed the landing line
+            float k = (landingY - prev.y) / (ball.pos.y - prev.y);
+            float x = prev.x + (ball.pos.x - prev.x) * k;
+
+            landings++;
+            if (pred.found && fabsf(pred.landing.x - x) <= LANDING_TOLERANCE) {
+                accurate++;
+            } else {
+                fprintf(stderr, "launch %d: predicted %.1f, landed at %.1f\n", launch, pred.landing.x, x);
+            }
+            break;
+        }
+    }
+
+    printf(
+        "%d/%d landings within %.0f px, %d rebuilds over %ld frames, %.3f us per update\n",
+        accurate,
+        landings,
+        LANDING_TOLERANCE,
+        rebuilds,
+        frames,
+        1e6 * elapsed / CLOCKS_PER_SEC / frames
+    );
+
+    return landings == TEST_LAUNCHES && accurate == landings ? 0 : 1;
+}